@@ -50,6 +50,7 @@ means given above.
 #include "../p2psim/eventgenerator.h"
 #include "../p2psim/p2psim.h"
 #include "../p2psim/args.h"
+#include "../p2psim/rng.h"
 #include <unistd.h>
 using namespace std;
 
@@ -79,10 +80,10 @@ private:
   bool _datakeys;
   vector<IPAddress> *_ips;
 
-  Time next_exponential(u_int mean);
-  Time next_uniform(u_int mean);
-  Time next_pareto(double a, u_int b);
-  string get_lookup_key();
+  Time next_exponential(Rng &r, u_int mean);
+  Time next_uniform(Rng &r, u_int mean);
+  Time next_pareto(Rng &r, double a, u_int b);
+  string get_lookup_key(Rng &r);
 };
 
 #endif // __CHURN_EVENT_GENERATOR_H
@@ -0,0 +1,41 @@
+#ifndef __TRACE_EVENT_GENERATOR_H
+#define __TRACE_EVENT_GENERATOR_H
+
+#include "../p2psim/eventgenerator.h"
+#include "../p2psim/p2psim.h"
+#include "../p2psim/args.h"
+#include "tracefile.h"
+#include <string>
+using namespace std;
+
+// Replays a binary trace (see tracefile.h).  The trace is mmap'd and
+// events are only created for the next `window' ms of simulated time
+// (default 10000), topped up from kick() as time moves on, so memory does
+// not grow with the length of the trace.
+//
+//   generator TraceEventGenerator name=FILE [window=MS]
+class TraceEventGenerator : public EventGenerator {
+public:
+  TraceEventGenerator(Args*);
+  ~TraceEventGenerator();
+  virtual void kick(Observed *, ObserverInfo*);
+  virtual void run();
+  virtual void save_state(ofstream&);
+  virtual void load_state(ifstream&);
+
+private:
+  string _name;
+  Time _window;
+
+  const trace_rec *_recs;
+  uint64_t _n;
+  uint64_t _next;       // first record without an event yet
+  uint64_t _released;   // records before this have been madvise'd away
+  Time _horizon;        // time of the last record with an event
+  void *_map;
+  size_t _maplen;
+
+  void inject();
+};
+
+#endif // __TRACE_EVENT_GENERATOR_H
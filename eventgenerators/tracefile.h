@@ -0,0 +1,50 @@
+#ifndef __TRACEFILE_H
+#define __TRACEFILE_H
+
+// Binary event trace, read by TraceEventGenerator and written by
+// misc/traceconvert from a text events file (the format FileEventGenerator
+// reads).  A 32 byte header is followed by fixed-size records sorted by
+// time:
+//
+//   char     magic[8]    "P2PTRCE1"
+//   uint64_t n           number of records
+//   uint64_t reserved[2]
+//
+// For TRACE_JOIN, key holds the well-known node (the wellknown= argument
+// of a text join); for the other operations it is the key= argument.
+// range is the range= argument of queries.  Keys are kept as numbers, the
+// text format writes them in hex and the well-known node in decimal, like
+// the wkn= of the event generators.
+
+#include <stdint.h>
+
+#define TRACE_MAGIC "P2PTRCE1"
+
+enum {
+  TRACE_JOIN = 0, TRACE_LEAVE, TRACE_CRASH, TRACE_INSERT, TRACE_LOOKUP,
+  TRACE_NODEEVENT, TRACE_QUERY, TRACE_NATIVE_QUERY, TRACE_NOPS,
+  TRACE_EXIT = 255      // "simulator TIME exit"
+};
+
+// indexed by op, the names P2PEvent understands
+static const char * const trace_op_names[TRACE_NOPS] = {
+  "join", "leave", "crash", "insert", "lookup", "nodeevent", "query",
+  "native_query"
+};
+
+struct trace_header {
+  char magic[8];
+  uint64_t n;
+  uint64_t reserved[2];
+};
+
+struct trace_rec {
+  uint64_t ts;
+  uint32_t node;        // first ip
+  uint8_t op;
+  uint8_t pad[3];
+  uint64_t key;
+  uint64_t range;
+};
+
+#endif // __TRACEFILE_H
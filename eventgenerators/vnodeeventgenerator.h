@@ -40,6 +40,9 @@ lookupmean      10000           average time (ms) between lookups per node
 exittime        200000          length of the experiment (in ms)
 ipkeys          false           generate lookups where keys are node IPs
 datakeys        false           generate lookups where keys are data items      
+vnodes          5               virtual nodes per physical host
+spares          0               vnodes per host that start dead, as room
+                                for load balancing moves
 Join, crash, and lookup events will be exponentially distributed about the
 means given above.
  */
@@ -50,6 +53,7 @@ means given above.
 #include "../p2psim/eventgenerator.h"
 #include "../p2psim/p2psim.h"
 #include "../p2psim/args.h"
+#include "../p2psim/rng.h"
 #include <unistd.h>
 using namespace std;
 
@@ -77,12 +81,14 @@ private:
   unsigned _uniform;
   bool _ipkeys;
   bool _datakeys;
+  int _num_of_vnode;
+  int _spares;
   vector<IPAddress> *_ips;
 
-  Time next_exponential(u_int mean);
-  Time next_uniform(u_int mean);
-  Time next_pareto(double a, u_int b);
-  string get_lookup_key();
+  Time next_exponential(Rng &r, u_int mean);
+  Time next_uniform(Rng &r, u_int mean);
+  Time next_pareto(Rng &r, double a, u_int b);
+  unsigned long long get_lookup_key(Rng &r);
 };
 
 #endif // __CHURN_EVENT_GENERATOR_H
@@ -0,0 +1,97 @@
+#ifndef __WORKLOAD_EVENT_GENERATOR_H
+#define __WORKLOAD_EVENT_GENERATOR_H
+
+#include "../p2psim/eventgenerator.h"
+#include "../p2psim/p2psim.h"
+#include "../p2psim/args.h"
+#include "../p2psim/aliastable.h"
+#include "../p2psim/rng.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+// YCSB-style operation mix over the keys of a dataset file (the SOSD
+// format eat_all() reads: a uint64_t count followed by the keys).  It
+// only issues operations; list it after a generator that joins the nodes
+// (e.g. VnodeEventGenerator with lookupmean=0).
+//
+//   generator WorkloadEventGenerator dataset=FILE [KEY=VAL ...]
+//
+// name          default   description
+// ---------------------------------------------------------------------
+// dataset                 the key file, mmap'd
+// loaded        all       the first `loaded' keys exist at the start;
+//                         inserts add the following ones, in file order
+// distribution  zipfian   uniform, zipfian, latest or hotspot
+// theta         0.99      zipfian and latest skew
+// scramble      1         zipfian: spread the hot keys over the key space
+// hotset        0.2       hotspot: fraction of keys that are hot ...
+// hotops        0.8       ... and fraction of operations that go to them
+// lookup        1         relative weights of point lookups,
+// insert        0           inserts
+// range         0           and range queries
+// selectivity   0.0001    fraction of the loaded keys a range query covers
+// rate          100       operations per second of simulated time, poisson
+// start         10000     time (ms) of the first operation
+// exittime      never     stop issuing operations (does not end the run)
+// placement     rank      ring location of a key: "rank" spreads the keys'
+//                         positions evenly over the ring (the ideal
+//                         learned placement), "rmi" uses the loaded RMI
+// window        10000     ms of operations created ahead of time
+class WorkloadEventGenerator : public EventGenerator {
+public:
+  WorkloadEventGenerator(Args *);
+  ~WorkloadEventGenerator();
+  virtual void kick(Observed *, ObserverInfo*);
+  virtual void run();
+  virtual void save_state(ofstream&);
+  virtual void load_state(ifstream&);
+
+private:
+  enum { UNIFORM, ZIPFIAN, LATEST, HOTSPOT };
+  enum { OP_LOOKUP, OP_INSERT, OP_RANGE };
+
+  string _dataset;
+  const uint64_t *_keys;
+  uint64_t _nkeys;      // in the file
+  uint64_t _loaded;     // keys [0, _loaded) exist
+  void *_map;
+  size_t _maplen;
+
+  unsigned _dist;
+  double _theta;
+  bool _scramble;
+  double _hotset;
+  double _hotops;
+  double _mix[3];
+  double _selectivity;
+  double _rate;
+  Time _exittime;
+  bool _rmi;
+  Time _window;
+
+  double _next;         // time of the next operation
+  Time _horizon;
+
+  // zipf over ranks 0.._zipf_n-1: the alias table picks a bucket of ranks
+  // (one rank each for the first ZIPF_EXACT, then 2^ZIPF_SUB_BITS buckets
+  // per power of two), a uniform draw picks the rank inside it.
+  static const unsigned ZIPF_EXACT = 1024;
+  static const unsigned ZIPF_SUB_BITS = 9;
+  AliasTable _zipf;
+  vector<uint64_t> _zipf_lo;
+  uint64_t _zipf_n;     // 0 until the first zipfian draw
+
+  vector<IPAddress> *_ips;
+  Rng _rng;
+
+  void build_zipf();
+  uint64_t zipf_rank();
+  uint64_t next_index();
+  unsigned long long location(uint64_t i);
+  void generate();
+  bool random_node(IPAddress &);
+};
+
+#endif // __WORKLOAD_EVENT_GENERATOR_H
@@ -32,10 +32,12 @@ public:
   P2PEvent();
   P2PEvent(vector<string>*);
   P2PEvent(Time, IPAddress, string, Args * = 0);
+  P2PEvent(Time, IPAddress, string, const p2p_op &);
 
   Node *node;
   P2Protocol::event_f fn;
-  Args *args;
+  Args *args;   // 0 for typed events, which use op instead
+  p2p_op op;
   string type;
 
  protected:
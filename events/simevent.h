@@ -34,9 +34,12 @@ public:
   ~SimEvent();
 
   virtual void execute();
+  string op() { return _op; }
+  string arg() { return _arg; }
 
 private:
   string _op;
+  string _arg;
 };
 
 #endif // __SIMEVENT_H
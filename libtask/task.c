@@ -16,6 +16,7 @@ int	taskcount;
 int	tasknswitch;
 int	taskexitval;
 Task	*taskrunning;
+static unsigned long long	taskslicestart;
 
 Context	taskschedcontext;
 Tasklist	taskrunqueue;
@@ -197,6 +198,20 @@ taskexit(int val)
 	taskswitch();
 }
 
+unsigned long long*
+taskcycles(unsigned long long *p)
+{
+	unsigned long long now, *old;
+
+	old = taskrunning->cycles;
+	now = taskcyclecount();
+	if(old)
+		*old += now - taskslicestart;
+	taskslicestart = now;
+	taskrunning->cycles = p;
+	return old;
+}
+
 static void
 contextswitch(Context *from, Context *to)
 {
@@ -224,7 +239,10 @@ taskscheduler(void)
 		taskrunning = t;
 		tasknswitch++;
 		taskdebug("run %d (%s)", t->id, t->name);
+		taskslicestart = taskcyclecount();
 		contextswitch(&taskschedcontext, &t->context);
+		if(t->cycles)
+			*t->cycles += taskcyclecount() - taskslicestart;
 //print("back in scheduler\n");
 		taskrunning = nil;
 		if(t->exiting){
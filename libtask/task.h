@@ -30,6 +30,33 @@ void		needstack(int);
 unsigned long		taskrendezvous(unsigned long, unsigned long);
 unsigned int		taskid(void);
 
+/*
+ * cpu accounting: while a task runs, the cycles it uses are added to
+ * the counter it last passed to taskcycles() (if any).  taskcycles()
+ * returns the previous counter, so callers can restore it.
+ */
+unsigned long long*	taskcycles(unsigned long long*);
+extern int		tasknswitch;
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline unsigned long long
+taskcyclecount(void)
+{
+	unsigned int lo, hi;
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((unsigned long long)hi << 32) | lo;
+}
+#else
+#include <time.h>
+static inline unsigned long long
+taskcyclecount(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
 /*
  * channel communication
  */
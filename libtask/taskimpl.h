@@ -128,6 +128,7 @@ struct Task
 	char	name[256];
 	char	state[256];
 	void *udata;
+	unsigned long long	*cycles;
 };
 
 void	taskready(Task*);
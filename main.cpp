@@ -31,6 +31,12 @@
 #include "p2psim/topology.h"
 #include "p2psim/eventgenerator.h"
 #include "p2psim/network.h"
+#include "p2psim/snapshot.h"
+#include "p2psim/timeline.h"
+#include "p2psim/log.h"
+#include "p2psim/profile.h"
+#include "p2psim/rng.h"
+#include "events/simevent.h"
 #include <ctime>
 #include <csignal>
 #include <iostream>
@@ -42,6 +48,13 @@ char *topology_file;
 char *event_file;
 char *protocol_file;
 vector<string> options;
+char *snapshot_at = 0;
+char *restore_file = 0;
+char *timeline_at = 0;
+char *log_at = 0;
+char *results_at = 0;
+double profile_period = 0;
+int rtt_samples = -1;
 
 bool vis = false;
 bool with_failure_model = true;
@@ -51,19 +64,38 @@ void parse_args(int argc, char *argv[]);
 void usage();
 
 void handle_signal_usr1(int sig) {
-    cout << "SIGUSR1: The current time is " << EventQueue::Instance()->time()
-         << endl;
+    // printed by the event queue at the next event
+    Profile::request_dump();
 }
 
 void taskmain(int argc, char *argv[]) {
-    time_t now = time(0);
-    string snow = "../logs/" + std::to_string(now) + ".txt";
-    static std::ofstream g_log(snow);
-    std::cout.rdbuf(g_log.rdbuf());
     p2psim_verbose = getenv("P2PSIM_DEBUG") ? atoi(getenv("P2PSIM_DEBUG")) : 0;
 
     srandom(time(0) ^ (getpid() + (getpid() << 15)));
+    Rng::seed(time(0) ^ (getpid() + (getpid() << 15)));
     parse_args(argc, argv);
+    Profile::start(profile_period);
+
+    // -B FILE:NAME
+    if (results_at) {
+        string x = results_at;
+        size_t colon = x.rfind(':');
+        if (colon == string::npos) {
+            usage();
+            exit(1);
+        }
+        Profile::results(x.substr(0, colon), x.substr(colon + 1));
+    }
+
+    // -L SPEC:FILE
+    if (log_at) {
+        string x = log_at;
+        size_t colon = x.rfind(':');
+        if (colon == string::npos || !Log::start(x.substr(0, colon), x.substr(colon + 1))) {
+            usage();
+            exit(1);
+        }
+    }
 
     //add in the optional args from parse_args
     Args a = Node::args();
@@ -84,21 +116,54 @@ void taskmain(int argc, char *argv[]) {
     while (anyready())
         yield();
 
-    DEBUG(0) << "average RTT = " << Network::Instance()->avglatency() * 2 << "ms" << endl;
+    if (rtt_samples < 0) {
+        DEBUG(0) << "average RTT = " << Network::Instance()->avglatency() * 2 << "ms" << endl;
+    } else if (rtt_samples > 0) {
+        double ci;
+        Time avg = Network::Instance()->avglatency(rtt_samples, &ci);
+        DEBUG(0) << "average RTT = " << avg * 2 << "ms (+/- " << ci * 2
+                 << "ms at 95% confidence, " << rtt_samples << " samples)" << endl;
+    }
 
     // make sure the network ate all the nodes
     while (anyready())
         yield();
+    Profile::nodes = Network::Instance()->getallfirstips()->size();
+    Profile::phase("join");
 
     // Creates an event queue, parses the file, etc.
     // Will fire off the EventQueue
     EventGenerator::parse(event_file);
 
-    // Initialize all protocols
-    if (Node::init_state()) {
+    // Initialize all protocols, either from a snapshot or statically
+    if (restore_file) {
+        Snapshot::restore(restore_file);
+    } else if (Node::init_state()) {
         const set<Node *> *all = Network::Instance()->getallnodes();
-        for (set<Node *>::const_iterator i = all->begin(); i != all->end(); ++i)
-            (*i)->initstate();
+        if (all->empty() || !(*all->begin())->initstate_all(all))
+            for (set<Node *>::const_iterator i = all->begin(); i != all->end(); ++i)
+                (*i)->initstate();
+    }
+
+    // -S TIME:FILE
+    if (snapshot_at) {
+        vector<string> x = split(snapshot_at, ":");
+        if (x.size() != 2) {
+            usage();
+            exit(1);
+        }
+        x.insert(x.begin() + 1, "snapshot");
+        EventQueue::Instance()->add_event(New SimEvent(&x));
+    }
+
+    // -T WINDOW:FILE
+    if (timeline_at) {
+        vector<string> x = split(timeline_at, ":");
+        if (x.size() != 2 || !atoll(x[0].c_str())) {
+            usage();
+            exit(1);
+        }
+        Timeline::start(strtoull(x[0].c_str(), NULL, 10), x[1]);
     }
 
 }
@@ -108,12 +173,19 @@ void parse_args(int argc, char *argv[]) {
     int ch;
     uint seed;
 
-    while ((ch = getopt(argc, argv, "e:fo:rv")) != -1) {
+    while ((ch = getopt(argc, argv, "a:B:e:fo:rvL:P:R:S:T:")) != -1) {
         switch (ch) {
+            case 'a':
+                rtt_samples = string(optarg) == "all" ? -1 : atoi(optarg);
+                break;
+            case 'B':
+                results_at = optarg;
+                break;
             case 'e':
                 seed = atoi(optarg);
                 // fprintf(stderr,"srand set seed to %u\n",seed);
                 srandom(seed);
+                Rng::seed(seed);
                 break;
             case 'f':
                 with_failure_model = false;
@@ -128,6 +200,21 @@ void parse_args(int argc, char *argv[]) {
             case 'v':
                 vis = true;
                 break;
+            case 'L':
+                log_at = optarg;
+                break;
+            case 'P':
+                profile_period = atof(optarg);
+                break;
+            case 'R':
+                restore_file = optarg;
+                break;
+            case 'S':
+                snapshot_at = optarg;
+                break;
+            case 'T':
+                timeline_at = optarg;
+                break;
             default:
                 usage();
         }
@@ -147,10 +234,21 @@ void parse_args(int argc, char *argv[]) {
 
 
 void usage() {
-    cout << "Usage: p2psim [-v] [-f] [-e SEED] PROTOCOL TOPOLOGY EVENTS" << endl;
+    cout << "Usage: p2psim [-v] [-f] [-e SEED] [-a SAMPLES] [-S TIME:FILE] [-R FILE] [-T WINDOW:FILE] [-L SPEC:FILE] [-P SECONDS] [-B FILE:NAME] PROTOCOL TOPOLOGY EVENTS" << endl;
     cout << "-v       : with vis" << endl;
     cout << "-f       : disable support for failure models" << endl;
     cout << "-e SEED  : set random seed SEED" << endl;
+    cout << "-a N     : estimate the average RTT from N random pairs instead of" << endl;
+    cout << "           averaging all pairs (\"all\", the default); 0 skips it" << endl;
+    cout << "-S T:F   : write a snapshot of the simulation at time T to file F" << endl;
+    cout << "-R FILE  : start from the snapshot in FILE instead of time 0" << endl;
+    cout << "-T W:F   : write metrics per W ms of simulated time to CSV file F" << endl;
+    cout << "-L S:F   : write binary log records to F (decode with logdecode); S is" << endl;
+    cout << "           a list of CATEGORY=LEVEL, e.g. all=1,query=2" << endl;
+    cout << "-P SECS  : print profiling counters to stderr every SECS wall-clock" << endl;
+    cout << "           seconds and at exit (kill -USR1 prints them once)" << endl;
+    cout << "-B F:N   : append wall time, events/s, peak RSS and phase times of" << endl;
+    cout << "           this run, named N, to file F" << endl;
     cout << "PROTOCOL : name of a protocol file" << endl;
     cout << "TOPOLOGY : name of a topology file" << endl;
     cout << "EVENTS   : name of an events file" << endl;
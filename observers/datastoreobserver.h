@@ -28,6 +28,7 @@
 #include "../p2psim/observer.h"
 #include "../protocols/consistenthash.h"
 #include "../protocols/chord.h"
+#include "../p2psim/rng.h"
 
 struct DataItem {
   Chord::CHID key;
@@ -46,6 +47,7 @@ public:
 
   vector<DataItem> get_data();
   DataItem get_random_item ();
+  DataItem get_random_item (Rng &r); // drawn from the caller's stream
 
 private:
   static DataStoreObserver *_instance;
@@ -27,9 +27,11 @@
 
 #include "../p2psim/observer.h"
 #include "../protocols/chordv.h"
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
 
 
-class LearnedDHTObserver : public Observer {
+class LearnedDHTObserver : public Observer, public Chord_vnodes::Ring {
 public:
   LearnedDHTObserver(Args*);
   ~LearnedDHTObserver();
@@ -37,19 +39,30 @@ public:
   void static_simulation();
   virtual void kick(Observed *, ObserverInfo *);
   vector<Chord_vnodes::IDMap> get_sorted_nodes();
+  void init_state(const set<Node*> *);
+
+  // the live ring by position, O(log N) each.  positions wrap around.
+  uint size() { return ids.size(); }
+  Chord_vnodes::IDMap at(long pos) {
+    long sz = ids.size();
+    assert(sz > 0);
+    pos %= sz;
+    if (pos < 0) pos += sz;
+    return ids.find_by_order(pos)->second;
+  }
+  // position of the first node whose id is >= k, or size() if none is
+  long lower(Chord_vnodes::CHID k) { return ids.order_of_key(k); }
+
   void addnode(Chord_vnodes::IDMap n) {
     if(_oracle_num) return;
-    vector<Chord_vnodes::IDMap>::iterator p =
-      upper_bound(ids.begin(),ids.end(),n,Chord_vnodes::IDMap::cmp);
-    if (p->id!=n.id) {
-      ids.insert(p,1,n);
-    }
+    ids.insert(make_pair(n.id, n));
     _totallivenodes++; 
   }
+  bool hasnode(Chord_vnodes::IDMap n) {
+    return ids.find(n.id) != ids.end();
+  }
   void delnode(Chord_vnodes::IDMap n) {
-    vector<Chord_vnodes::IDMap>::iterator p =
-      find(ids.begin(),ids.end(),n);
-    ids.erase(p);
+    ids.erase(n.id);
     _totallivenodes--; 
   }
 
@@ -58,8 +71,12 @@ private:
   string _type;
   unsigned int _oracle_num;
 
-  void init_state();
-  vector<Chord_vnodes::IDMap> ids;
+  void notify_neighbors(Chord_vnodes *n, bool joined);
+
+  typedef __gnu_pbds::tree<Chord_vnodes::CHID, Chord_vnodes::IDMap,
+                           less<Chord_vnodes::CHID>, __gnu_pbds::rb_tree_tag,
+                           __gnu_pbds::tree_order_statistics_node_update> ring_t;
+  ring_t ids;
   uint _totallivenodes;
 };
 
@@ -0,0 +1,32 @@
+#ifndef __ALIASTABLE_H
+#define __ALIASTABLE_H
+
+// Walker/Vose alias table: after an O(n) build, draws index i with
+// probability weights[i] / sum(weights) in O(1) from one uniform number.
+
+#include <vector>
+using namespace std;
+
+class AliasTable {
+public:
+  AliasTable() {}
+  AliasTable(const vector<double> &weights) { build(weights); }
+
+  void build(const vector<double> &weights);
+  unsigned size() const { return _prob.size(); }
+
+  // u is uniform in [0,1)
+  unsigned sample(double u) const {
+    double x = u * _prob.size();
+    unsigned i = (unsigned) x;
+    if(i >= _prob.size())
+      i = _prob.size() - 1;
+    return x - i < _prob[i] ? i : _alias[i];
+  }
+
+private:
+  vector<double> _prob;
+  vector<unsigned> _alias;
+};
+
+#endif // __ALIASTABLE_H
@@ -28,6 +28,7 @@
 #include "observer.h"
 #include <fstream>
 #include <string>
+#include <vector>
 #include "threaded.h"
 #include "eventqueueobserver.h"
 using namespace std;
@@ -39,6 +40,17 @@ public:
 
   // creates all specified event generators and observers
   static void parse(char *filename);
+
+  // snapshot/restore, see snapshot.h.  generators that create events
+  // ahead of time save where they are, so that a restored run neither
+  // repeats nor skips any.  run() sees Snapshot::restoring() and must not
+  // schedule what the snapshot already holds.
+  virtual void save_state(ofstream&) {};
+  virtual void load_state(ifstream&) {};
+  static const vector<EventGenerator*> &all() { return _all; }
+
+private:
+  static vector<EventGenerator*> _all;
 };
 
 #endif //  __EVENT_GENERATOR_H
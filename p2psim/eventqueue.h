@@ -34,6 +34,7 @@ using namespace std;
 
 class EventQueue : public Threaded, public Observed {
   friend class EventQueueObserver;
+  friend class Snapshot;
 
 public:
   static EventQueue* Instance();
@@ -59,6 +60,7 @@ private:
   static EventQueue *_instance;
   Time _time;
   Channel *_gochan;
+  bool _started;
 
   virtual void run();
   bool advance();
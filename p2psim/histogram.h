@@ -0,0 +1,61 @@
+#ifndef __HISTOGRAM_H
+#define __HISTOGRAM_H
+
+// Log-bucketed (HDR-style) histogram for statistics that used to be kept
+// as one vector entry per sample and sorted at the end of the run.
+//
+// Values are scaled by 1/unit and rounded to integers.  Integers below
+// 2^SUB_BITS get a bucket each; above that every power of two is split
+// into 2^(SUB_BITS-1) equal buckets, so a recorded value is off by at most
+// 1/2^SUB_BITS relative.  record() is O(1), memory only grows with the
+// magnitude of the largest value, and histograms with the same unit can be
+// merged.  count, sum, min and max are exact.
+
+#include <stdint.h>
+#include <fstream>
+#include <vector>
+using namespace std;
+
+class Histogram {
+public:
+  // unit is the resolution of small values, e.g. 0.001 for stretch.
+  Histogram(double unit = 1);
+
+  void record(double v);
+  void merge(const Histogram &);
+  void clear();
+
+  uint64_t count() const { return _count; }
+  double sum() const { return _sum; }
+  double mean() const { return _count ? _sum / _count : 0; }
+  double min() const { return _count ? _min : 0; }
+  double max() const { return _count ? _max : 0; }
+
+  // value of the r'th smallest sample (0-based), as if the samples were
+  // sorted into a vector.
+  double at_rank(uint64_t r) const;
+  // p in [0,100], e.g. 99.99
+  double percentile(double p) const;
+  // the same median the old vector-based code printed: the mean of the
+  // two middle samples if count is even.
+  double median() const;
+
+  // snapshot/restore
+  void save(ofstream &) const;
+  void load(ifstream &);
+
+  static const unsigned SUB_BITS = 10;
+
+private:
+  double _unit;
+  uint64_t _count;
+  double _sum;
+  double _min;
+  double _max;
+  vector<uint64_t> _buckets;
+
+  static unsigned index(uint64_t);
+  static uint64_t midpoint(unsigned);
+};
+
+#endif // __HISTOGRAM_H
@@ -0,0 +1,121 @@
+#ifndef __LOG_H
+#define __LOG_H
+
+// Leveled, binary logging for hot paths.
+//
+//   LOG(LOG_QUERY, LOG_DEBUG, "query from %u took %llu ms", src, interval);
+//
+// Arguments must be integers or floating point values.  A record holds
+// the simulated time, a format id and the raw argument values; nothing is
+// formatted while the simulation runs.  Records go through a lock-free
+// single-producer ring buffer to a background thread that writes them to
+// the log file.  Format strings are written once, the first time each LOG
+// statement fires.  misc/logdecode.C turns a log file back into text.
+//
+// Levels above LOG_MAX_LEVEL (default LOG_DEBUG, override with
+// -DLOG_MAX_LEVEL=...) compile to nothing.  At runtime every category is
+// off until enabled, with p2psim -L SPEC:FILE where SPEC is a comma
+// separated list of CATEGORY=LEVEL, e.g. "all=1,query=3".
+
+#include "p2psim.h"
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+using namespace std;
+
+enum { LOG_ERROR = 0, LOG_INFO = 1, LOG_DEBUG = 2, LOG_TRACE = 3, LOG_NLEVELS };
+enum { LOG_SIM = 0, LOG_NET, LOG_JOIN, LOG_LOOKUP, LOG_QUERY, LOG_STAB,
+       LOG_DATA, LOG_NCATS };
+
+static const char * const log_level_names[LOG_NLEVELS] = {
+  "error", "info", "debug", "trace"
+};
+static const char * const log_category_names[LOG_NCATS] = {
+  "sim", "net", "join", "lookup", "query", "stab", "data"
+};
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_DEBUG
+#endif
+
+#define LOG(cat, level, fmt, ...) do {                                  \
+  if((level) <= LOG_MAX_LEVEL && Log::enabled((cat), (level))) {        \
+    static const uint32_t _log_fmt =                                    \
+      Log::format((cat), (level), __FILE__, __LINE__, (fmt));           \
+    Log::write(_log_fmt, ##__VA_ARGS__);                                \
+  }                                                                     \
+} while(0)
+
+// on-disk layout, after the 8 byte magic "P2PLOG01".  every record starts
+// with a log_rec; LOG_REC_EVENT is followed by nargs uint64_t values (two
+// bits of type per argument in tags), LOG_REC_FORMAT by "file:line\0fmt\0".
+enum { LOG_REC_EVENT = 0, LOG_REC_FORMAT = 1 };
+enum { LOG_ARG_INT = 0, LOG_ARG_UINT = 1, LOG_ARG_DOUBLE = 2 };
+#define LOG_MAX_ARGS 16
+
+struct log_rec {
+  uint16_t size;     // of the whole record
+  uint8_t kind;
+  uint8_t nargs;     // EVENT: number of arguments.  FORMAT: level
+  uint32_t id;       // format id
+  uint64_t ts;       // EVENT: simulated time.  FORMAT: category
+  uint32_t tags;
+  uint32_t pad;
+};
+
+class Log {
+public:
+  static bool start(string spec, string file);
+  static void stop();
+
+  static bool enabled(int cat, int level) { return level <= _level[cat]; }
+  static uint32_t format(int cat, int level, const char *file, int line,
+                         const char *fmt);
+
+  template<typename... A>
+  static void write(uint32_t id, A... args) {
+    static_assert(sizeof...(A) <= LOG_MAX_ARGS, "too many LOG arguments");
+    char buf[sizeof(log_rec) + 8 * LOG_MAX_ARGS + 8];
+    log_rec *r = (log_rec *) buf;
+    r->kind = LOG_REC_EVENT;
+    r->nargs = 0;
+    r->id = id;
+    r->ts = clock();
+    r->tags = 0;
+    r->pad = 0;
+    uint64_t *v = (uint64_t *) (buf + sizeof(log_rec));
+    pack(r, v, args...);
+    r->size = sizeof(log_rec) + 8 * r->nargs;
+    append(buf, r->size);
+  }
+
+private:
+  static int _level[LOG_NCATS];
+
+  static Time clock();
+  static void append(const void *, unsigned);
+
+  static void pack(log_rec *, uint64_t *) { }
+  template<typename T, typename... A>
+  static void pack(log_rec *r, uint64_t *v, T x, A... rest) {
+    static_assert(is_arithmetic<T>::value, "LOG arguments must be numbers");
+    uint32_t tag;
+    if(is_floating_point<T>::value) {
+      double d = (double) x;
+      memcpy(&v[r->nargs], &d, 8);
+      tag = LOG_ARG_DOUBLE;
+    } else if(is_signed<T>::value) {
+      v[r->nargs] = (uint64_t) (int64_t) x;
+      tag = LOG_ARG_INT;
+    } else {
+      v[r->nargs] = (uint64_t) x;
+      tag = LOG_ARG_UINT;
+    }
+    r->tags |= tag << (2 * r->nargs);
+    r->nargs++;
+    pack(r, v, rest...);
+  }
+};
+
+#endif // __LOG_H
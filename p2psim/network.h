@@ -29,7 +29,6 @@
 #include "topology.h"
 #include "node.h"
 #include "failuremodel.h"
-#include "bighashmap.hh"
 #include <list>
 using namespace std;
 
@@ -39,19 +38,20 @@ public:
   static Network* Instance(Topology*, FailureModel*);
   Channel* nodechan() { return _nodechan; }
   void send(Packet *);
+  Time link_in(Packet *);
 
   // observers
-  Node* getnode(IPAddress id) { return _nodes[first_ip(id)];}
+  Node* getnode(IPAddress id) { return getnodefromfirstip(first_ip(id)); }
 
   Node* getnodefromfirstip(IPAddress f) {
-    return _nodes[f];
+    return f < _nodes.size() ? _nodes[f] : 0;
   }
   IPAddress first2currip (IPAddress first_ip) { return _nodes[first_ip]->ip();}
   Topology *gettopology() { return _top; }
   const set<Node*> *getallnodes();
   vector<IPAddress> *getallfirstips();
-  unsigned size() { return _nodes.size(); }
-  Time avglatency();
+  unsigned size() { return _nnodes; }
+  Time avglatency(unsigned samples = 0, double *ci = 0);
   bool alive(IPAddress ip) {
     Node *n = getnode(ip);
     return (n->ip()==ip && n->alive());
@@ -60,28 +60,48 @@ public:
   // 
   IPAddress unused_ip();
   void map_ip(IPAddress, IPAddress);
-  IPAddress first_ip(IPAddress);
+  IPAddress first_ip(IPAddress newx) {
+    return newx < _new2old.size() && _new2old[newx] ? _new2old[newx] : newx;
+  }
   bool changed() { return _changed; }
 
+  // snapshot/restore of the ip remapping
+  void save_state(ofstream&);
+  void load_state(ifstream&);
+
   ~Network();
 
 private:
   Network(Topology*, FailureModel*);
 
   virtual void run();
-  float gaussian(double var);
+  float gaussian(Rng &, double var);
+  Time link_out(Packet *, Node *src, Time latency);
+
+  // link model: when the access links of a node, by first ip, are done
+  // sending and receiving what was queued on them, in ms
+  vector<double> _up_free;
+  vector<double> _down_free;
+  double _link_delay_sum;
+  double _link_delay_max;
+  unsigned long long _link_packets;
 
   static Network *_instance;
 
-  HashMap<IPAddress, Node*> _nodes;
+  // node directory, indexed by first ip.  ips are small dense integers
+  // (node-ids from the topology file), so this is a flat array.
+  vector<Node*> _nodes;
+  unsigned _nnodes;
   Topology *_top;
   FailureModel *_failure_model;
 
   set<Node*> *_all_nodes;
   vector<IPAddress> *_all_ips;
-  HashMap<IPAddress, bool> _corpses;
 
-  HashMap<IPAddress, IPAddress> _new2old;
+  // first ip of nodes that rejoined under a new ip (see
+  // Node::_replace_on_death), indexed by the new ip, 0 if not remapped.
+  // new ips come from unused_ip(), so this is dense too.
+  vector<IPAddress> _new2old;
   IPAddress _highest_ip;
   bool _changed;
   Channel *_nodechan;
@@ -31,8 +31,13 @@
 #include "observed.h"
 #include "args.h"
 #include "bighashmap.hh"
+#include "histogram.h"
+#include "profile.h"
+#include "rng.h"
 #include <assert.h>
 #include <stdio.h>
+#include <fstream>
+#include <typeinfo>
 
 // A Node is the superclass of
 // The point is, for example, to help the Chord object on
@@ -45,6 +50,9 @@ public:
   virtual ~Node();
   static void parse(char*);
   virtual void initstate() {};
+  // initializes all nodes at once instead of calling initstate() on
+  // each.  returns false if the protocol has no such shortcut.
+  virtual bool initstate_all(const set<Node*> *) { return false; }
   virtual string proto_name() { return "Node";}
 
   IPAddress ip() { return _ip; }
@@ -69,10 +77,10 @@ public:
   typedef uint stat_type;
   const static stat_type STAT_LOOKUP = 0;
   unsigned long get_out_bw_stat() { return node_live_outbytes;}
-  void record_bw_stat(stat_type type, uint num_ids, uint num_else);
-  static void record_inout_bw_stat(IPAddress src, IPAddress dst, uint num_ids, uint num_else);
-  void record_in_bytes(uint b);
-  void record_out_bytes(uint b); 
+  void record_bw_stat(stat_type type, uint num_ids, uint64_t num_else);
+  static void record_inout_bw_stat(IPAddress src, IPAddress dst, uint num_ids, uint64_t num_else);
+  void record_in_bytes(uint64_t b);
+  void record_out_bytes(uint64_t b); 
   static void record_lookup_stat(IPAddress src, IPAddress dst, Time interval, 
 				 bool complete, bool correct, 
 				 uint num_hops = 0, uint num_timeouts = 0, 
@@ -93,11 +101,30 @@ public:
   int queue_delay () { return _queue_len; };
   void queue_delay (int q) { _queue_len = q; };
 
+  // called by an RPC handler: the size in bytes of its reply
+  static void reply_size(uint64_t bytes);
+
   // whether nodes should be replace when they die
   static bool _replace_on_death;
 
   IPAddress first_ip() { return _first_ip; }
 
+  // this node's random stream for purpose, see rng.h
+  Rng &rng(unsigned purpose) { return _rng[purpose]; }
+
+  // snapshot/restore, see snapshot.h.  subclasses that keep state worth
+  // restoring must call their parent's save_state()/load_state() first.
+  virtual void save_state(ofstream&);
+  virtual void load_state(ifstream&);
+  // called once all state is restored; re-arm periodic timers here.
+  virtual void restored() {};
+  // state all nodes of a protocol share (class statics); a snapshot
+  // saves and restores it through one node only.
+  virtual void save_shared(ofstream&) {};
+  virtual void load_shared(ifstream&) {};
+  static void save_stats(ofstream&);
+  static void load_stats(ifstream&);
+
 protected:
   typedef set<unsigned> RPCSet;
 
@@ -105,23 +132,22 @@ protected:
   uint _track_conncomp_timer;
   static vector<unsigned long> _bw_stats;
   static vector<uint> _bw_counts;
-  static vector<Time> _correct_lookups;
-  static vector<Time> _incorrect_lookups;
-  static vector<Time> _failed_lookups;
-  static  vector<Time> _nows;
-
-  static vector<Time> _correct_lookups_query;
-  static vector<Time> _incorrect_lookups_query;
-  static vector<Time> _failed_lookups_query;
-
-  static vector<double> _correct_stretch;
-  static vector<double> _incorrect_stretch;
-  static vector<double> _failed_stretch;
-  static vector<uint> _correct_hops;
-  static vector<uint> _incorrect_hops;
-  static vector<uint> _failed_hops;
-  static vector<double> _num_timeouts;
-  static vector<Time> _time_timeouts;
+  static Histogram _correct_lookups;
+  static Histogram _incorrect_lookups;
+  static Histogram _failed_lookups;
+
+  static Histogram _correct_lookups_query;
+  static Histogram _incorrect_lookups_query;
+  static Histogram _failed_lookups_query;
+
+  static Histogram _correct_stretch;
+  static Histogram _incorrect_stretch;
+  static Histogram _failed_stretch;
+  static Histogram _correct_hops;
+  static Histogram _incorrect_hops;
+  static Histogram _failed_hops;
+  static Histogram _num_timeouts;
+  static Histogram _time_timeouts;
   static vector<uint> _num_joins;
   static vector<Time> _last_joins;
   static vector<Time> _time_sessions;
@@ -134,9 +160,9 @@ protected:
   static uint totalin;
   static uint totalout;
   int _num_joins_pos;
-  static void print_lookup_stat_helper( vector<Time> times, 
-					vector<double> stretch,
-					vector<uint> hops,
+  static void print_lookup_stat_helper( const Histogram &times, 
+					const Histogram &stretch,
+					const Histogram &hops,
 					bool timeouts = false );
   void check_num_joins_pos();
   int _queue_len;
@@ -190,13 +216,16 @@ protected:
 
 
   // Send an RPC from a Node on one Node to a method
-  // of the same Node sub-class with a different ip
+  // of the same Node sub-class with a different ip.
+  // size is the request's size in bytes for the link model, see
+  // Network::link_out(); the handler declares its reply's with reply_size().
   template<class BT, class AT, class RT> 
-  bool doRPC(IPAddress dst, void (BT::* fn)(AT *, RT *), AT *args, RT *ret, Time timeout = 0)
+  bool doRPC(IPAddress dst, void (BT::* fn)(AT *, RT *), AT *args, RT *ret, Time timeout = 0,
+      uint64_t size = 0)
   {
     assert(dst > 0);
     Thunk<BT, AT, RT> *t = _makeThunk(dst, dynamic_cast<BT*>(getpeer(dst)), fn, args, ret);
-    bool ok = _doRPC(dst, Thunk<BT, AT, RT>::thunk, (void *) t, timeout);
+    bool ok = _doRPC(dst, Thunk<BT, AT, RT>::thunk, (void *) t, timeout, size);
     delete t;
     return ok;
   }
@@ -204,14 +233,15 @@ protected:
   // Same as doRPC, but this one is asynchronous
   template<class BT, class AT, class RT>
   unsigned asyncRPC(IPAddress dst,
-      void (BT::* fn)(AT *, RT *), AT *args, RT *ret, Time timeout = 0, unsigned token = 0)
+      void (BT::* fn)(AT *, RT *), AT *args, RT *ret, Time timeout = 0, unsigned token = 0,
+      uint64_t size = 0)
   {
     assert(dst);
     while(!token || _rpcmap[token])
       token = _token++;
 
     Thunk<BT, AT, RT> *t = _makeThunk(dst, dynamic_cast<BT*>(getpeer(dst)), fn, args, ret);
-    RPCHandle *rpch = _doRPC_send(dst, Thunk<BT, AT, RT>::thunk, Thunk<BT, AT, RT>::killme, (void *) t, timeout);
+    RPCHandle *rpch = _doRPC_send(dst, Thunk<BT, AT, RT>::thunk, Thunk<BT, AT, RT>::killme, (void *) t, timeout, size);
 
     if(!rpch)
       return 0;
@@ -243,9 +273,13 @@ protected:
     AT *_args;
     RT *_ret;
     static void thunk(void *xa) {
+      static Profile::slot *s = Profile::rpc_slot(typeid(Thunk).name());
       Thunk *t = (Thunk *) xa;
+      s->count++;
+      unsigned long long *prev = taskcycles(&s->cycles);
       (t->_target->*(t->_fn))(t->_args, t->_ret);
       t->_target->notifyObservers();
+      taskcycles(prev);
     }
 
     static void killme(void *xa) {
@@ -255,8 +289,8 @@ protected:
 
   // implements _doRPC
   friend class Vivaldi;
-  bool _doRPC(IPAddress, void (*fn)(void *), void *args, Time timeout = 0);
-  RPCHandle* _doRPC_send(IPAddress, void (*)(void *), void (*)(void*), void *, Time = 0);
+  bool _doRPC(IPAddress, void (*fn)(void *), void *args, Time timeout = 0, uint64_t size = 0);
+  RPCHandle* _doRPC_send(IPAddress, void (*)(void *), void (*)(void*), void *, Time = 0, uint64_t = 0);
   bool _doRPC_receive(RPCHandle*);
 
   // creates a Thunk object with the necessary croft for an RPC
@@ -285,6 +319,7 @@ protected:
 
   IPAddress _first_ip;
   IPAddress _prev_ip;
+  Rng _rng[RNG_NPURPOSES];
 };
 
 #define ADEBUG(x) if(p2psim_verbose >= (x)) cout << header() 
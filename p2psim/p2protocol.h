@@ -33,6 +33,18 @@ using namespace std;
 
 class Node;
 
+// Typed arguments of an operation, for events made by event generators.
+// Args, a map of strings, is only used by the text front end.
+struct p2p_op {
+  p2p_op(unsigned long long k = 0) :
+    key(k), range_end(0), orig_key(0), flags(0), batch(0) {}
+  unsigned long long key;
+  unsigned long long range_end;
+  unsigned long long orig_key;  // inserts: the data key before placement
+  unsigned flags;
+  unsigned batch;
+};
+
 class P2Protocol : public Node {
 public:
   P2Protocol(IPAddress);
@@ -49,6 +61,11 @@ public:
   virtual void range_query_leanred(Args*) {}
   virtual void range_query_native(Args*) {}
   virtual void query(Args*) {}
+
+  // runs event fn with typed arguments.  the default spells op out as
+  // Args (key=, range=, flags=, batch=, all in hex) and calls fn;
+  // protocols override it for the operations they want without that.
+  virtual void execute_op(event_f fn, const p2p_op &op);
 };
 
 #endif // __DHTPROTOCOL_H
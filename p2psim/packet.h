@@ -44,6 +44,7 @@ public:
   unsigned id() { return _id; }
   bool ok()     { return _ok; }
   Time timeout() { return _timeout; }
+  uint64_t size() { return _size; }
 
 private:
   // RPC function and arguments.
@@ -62,6 +63,9 @@ private:
   bool _ok;               // was the target node available?
   unsigned _id;
   Time _timeout;          // if set, after how long this RPC should time out
+  uint64_t _size;         // bytes as declared by the sender, 0 if undeclared
+  double _arrive;         // link model: when its first byte reaches dst, < 0 once it is in
+  double _link_delay;     // link model: ms spent in access link queues and serialization
   static unsigned _unique;
 };
 
@@ -0,0 +1,89 @@
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+// Always-on profiling counters, to see where a long run spends its time
+// without attaching a profiler.
+//
+// CPU time is measured in TSC cycles by the libtask scheduler and charged
+// to whatever a coroutine is currently doing: the event type it was
+// created for, or the RPC handler it is running (see taskcycles()).
+// Cycles are converted to ms with a rate calibrated against the wall
+// clock since start(), so no fixed clock frequency is assumed.
+//
+// kill -USR1 prints a report to stderr at the next event; p2psim
+// -P SECONDS also prints one every SECONDS of wall-clock time and at exit.
+//
+// p2psim -B FILE:NAME appends one line of key=value results for the
+// whole run to FILE at exit (see scripts/sim-scale-bench.py): wall time,
+// events/s, peak RSS, coroutines and the wall time of each phase(),
+// topology, join, steady and stats.
+
+#include "p2psim.h"
+#include <signal.h>
+#include <stdint.h>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+class Event;
+
+class Profile {
+public:
+  struct slot {
+    string name;
+    uint64_t count;
+    unsigned long long cycles;
+  };
+
+  static void start(double period = 0);
+  static void dump(ostream &);
+
+  static slot *event_slot(Event *);
+  // mangled is typeid(Node::Thunk<...>).name()
+  static slot *rpc_slot(const char *mangled);
+  static slot *queue_slot() { return &_queue; }
+
+  // called by the event queue for every batch of events
+  static void poll() {
+    if(_dump_requested || (_period && !(++_polls & 1023) && due()))
+      periodic_dump();
+  }
+  // async-signal-safe
+  static void request_dump() { _dump_requested = 1; }
+
+  // the run enters phase name, ending the previous one
+  static void phase(const char *name);
+  static void results(string file, string name);
+
+  static uint64_t events_run;
+  static uint64_t events_queued;
+  static uint64_t events_queued_max;
+  static uint64_t coroutines;
+  // operator new/delete count from every thread, not just the scheduler's
+  static atomic<uint64_t> allocs;
+  static atomic<uint64_t> frees;
+  static atomic<uint64_t> alloc_bytes;
+  static uint64_t nodes;
+
+private:
+  static vector<slot *> _events;
+  static vector<slot *> _rpcs;
+  static slot _queue;
+
+  static double _period;
+  static unsigned _polls;
+  static volatile sig_atomic_t _dump_requested;
+
+  static vector<pair<string, double> > _phases;
+  static string _results_file;
+  static string _results_name;
+
+  static bool due();
+  static void periodic_dump();
+  static void atexit_dump();
+  static void atexit_results();
+};
+
+#endif // __PROFILE_H
@@ -0,0 +1,71 @@
+#ifndef __RNG_H
+#define __RNG_H
+
+// Counter-based random number streams.
+//
+// Draw number i of stream (key, purpose) is a pure function of the seed,
+// the key, the purpose and i, so a stream's values do not depend on how
+// many draws other streams made or in which order.  Changing the event
+// order, or running parts of the simulation in parallel, leaves every
+// stream that is not itself affected unchanged.
+//
+// Nodes own one stream per purpose, keyed by their first ip (see
+// Node::rng()).  Code that is not per-node uses key 0.  The values are
+// SplitMix64 finalizer mixes of (seed, key, purpose, counter).
+
+#include <math.h>
+#include <stdint.h>
+
+enum {
+  RNG_ID = 0,     // node identifiers
+  RNG_KEY,        // lookup keys chosen by observers
+  RNG_LOSS,       // packet loss, per sender
+  RNG_DELAY,      // Network::gaussian
+  RNG_SKIPLIST,   // skiplist levels
+  RNG_STAB,       // stabilization timer jitter
+  RNG_CHURN,      // lifetimes and downtimes, per node
+  RNG_LOOKUP,     // lookup times and keys, per node
+  RNG_WORKLOAD,   // WorkloadEventGenerator
+  RNG_VIVALDI,    // Vivaldi coordinate nudges, per node
+  RNG_VALUE,      // value sizes of inserts, per node
+  RNG_NPURPOSES
+};
+
+class Rng {
+public:
+  Rng(uint64_t key = 0, unsigned purpose = 0) :
+    _key(key), _purpose(purpose), _ctr(0) {}
+
+  // p2psim -e SEED sets this before anything draws
+  static void seed(uint64_t s) { _seed = s; }
+
+  static uint64_t at(uint64_t key, unsigned purpose, uint64_t ctr) {
+    uint64_t s = mix(_seed ^ mix(key + ((uint64_t) purpose << 48)));
+    return mix(s + (ctr + 1) * 0x9E3779B97F4A7C15ULL);
+  }
+
+  uint64_t next() { return at(_key, _purpose, _ctr++); }
+  // [0, 1)
+  double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+  // [0, n)
+  uint64_t below(uint64_t n) { return n ? next() % n : 0; }
+  double exponential(double mean) { return -mean * log(1 - uniform()); }
+
+  // for snapshots
+  uint64_t counter() const { return _ctr; }
+  void set_counter(uint64_t c) { _ctr = c; }
+
+private:
+  uint64_t _key;
+  unsigned _purpose;
+  uint64_t _ctr;
+  static uint64_t _seed;
+
+  static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+};
+
+#endif // __RNG_H
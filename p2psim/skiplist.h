@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <unistd.h>
 #include "keyfunc.h"
+#include "rng.h"
 
 /*
  * Template implementation of Skip Lists.
@@ -45,7 +46,10 @@ class skiplist {
 
   static unsigned int rndlvl () {
     unsigned int l = 1;
-    while (((random () / (float) RAND_MAX) < 0.50) &&
+    // a private stream: levels only affect speed, and drawing them
+    // from random() would shift every later draw of the simulation
+    static Rng r (0, RNG_SKIPLIST);
+    while ((r.next () & 1) &&
 	   l < SKLIST_MAX_LEVS)
       l++;
     return l;
@@ -207,6 +211,40 @@ class skiplist {
     return true;
   }
 
+  // Builds the list from n elements in increasing key order in O(n).
+  // The list must be empty.  Levels are fixed (every 2^j-th element is
+  // j+1 high), so no random levels are drawn and different lists can
+  // be built from different threads.
+  void build (T **elms, unsigned int n) {
+    assert (head == NULL);
+    T *last[SKLIST_MAX_LEVS];
+    unsigned int i, j, l;
+    for (i = 0; i < n; i++) {
+      T *elm = elms[i];
+      assert (!i || cmp (elms[i - 1]->*key, elm->*key) < 0);
+      if (i == 0)
+	l = SKLIST_MAX_LEVS;
+      else
+	for (l = 1; l < SKLIST_MAX_LEVS && !(i & ((1U << l) - 1)); l++)
+	  ;
+      if (i && l > lvl)
+	lvl = l;
+      (elm->*field).previous = i ? elms[i - 1] : NULL;
+      for (j = 0; j < SKLIST_MAX_LEVS; j++)
+	(elm->*field).forward[j] = NULL;
+      for (j = 0; j < l; j++) {
+	if (i)
+	  (last[j]->*field).forward[j] = elm;
+	last[j] = elm;
+      }
+    }
+    if (n) {
+      head = elms[0];
+      tail = elms[n - 1];
+    }
+    sz = n;
+  }
+
   T *remove (const K &k) {
     T *oldhead = head;
     if (head == NULL) {
@@ -0,0 +1,67 @@
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+// Saves and restores the simulator state in a compact binary file so that
+// a run can skip the join/stabilization warm-up.
+//
+// What is captured: simulated time, the Network ip remapping, every Node's
+// persistent state (via Node::save_state(), e.g. Chord_vnodes location tables
+// and key_pairs), the global statistics counters, the state protocols keep
+// in statics (Node::save_shared()), the position of every EventGenerator in
+// its event stream and all pending P2PEvents and SimEvents.  A restore must
+// use the same topology and event file as the run that saved it.
+//
+// What is NOT captured: running threads, i.e. in-flight RPCs (NetEvents) and
+// delaycb() timers.  After a restore every Node gets Node::restored() called
+// so that it can re-arm its periodic timers (stabilizers etc.).
+//
+// Usage: p2psim -S TIME:FILE ... writes a snapshot at simulated time TIME,
+//        p2psim -R FILE ... starts from a snapshot instead of time 0.
+
+#include "p2psim.h"
+#include "args.h"
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+class Snapshot {
+public:
+  static void save(string file);
+  static void restore(string file);
+  static bool restoring() { return _restoring; }
+
+  // binary helpers, used by Node::save_state() and friends
+  template<class T>
+  static void put(ofstream &out, const T &v) {
+    out.write((const char *) &v, sizeof(T));
+  }
+  template<class T>
+  static void get(ifstream &in, T &v) {
+    in.read((char *) &v, sizeof(T));
+  }
+  template<class T>
+  static void put_vec(ofstream &out, const vector<T> &v) {
+    unsigned sz = v.size();
+    put(out, sz);
+    if(sz)
+      out.write((const char *) &v[0], sizeof(T) * sz);
+  }
+  template<class T>
+  static void get_vec(ifstream &in, vector<T> &v) {
+    unsigned sz;
+    get(in, sz);
+    v.resize(sz);
+    if(sz)
+      in.read((char *) &v[0], sizeof(T) * sz);
+  }
+  static void put_str(ofstream &, const string &);
+  static void get_str(ifstream &, string &);
+  static void put_args(ofstream &, Args *);
+  static Args *get_args(ifstream &);
+
+private:
+  static bool _restoring;
+};
+
+#endif // __SNAPSHOT_H
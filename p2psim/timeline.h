@@ -0,0 +1,58 @@
+#ifndef __TIMELINE_H
+#define __TIMELINE_H
+
+// Metrics timeline: lookup/query latency, hops, timeouts, bytes per RPC
+// type and the number of live nodes, aggregated over fixed windows of
+// simulated time and appended to a CSV file (one row per window) while
+// the simulation runs.  Turned on with p2psim -T WINDOW:FILE.
+//
+// Windows are closed by a "timeline" SimEvent that re-schedules itself, so
+// the live node count is taken at the end of each window.  When the
+// timeline is off, the record hooks cost a single test of a static flag.
+
+#include "p2psim.h"
+#include "histogram.h"
+#include <fstream>
+#include <string>
+using namespace std;
+
+class Timeline {
+public:
+  static void start(Time window, string file);
+  static bool on() { return _on; }
+
+  // called by the "timeline" SimEvent, and at exit for the last window
+  static void tick();
+  static void flush();
+
+  static void lookup(Time interval, bool complete, bool correct,
+                     uint hops, uint timeouts);
+  static void query(Time interval, bool complete, bool correct);
+  static void bytes(uint type, uint64_t b);
+
+  // bytes of these RPC types get their own columns, the rest are summed
+  // into bytes_other.  chord-style protocols use 0..8 (see TYPE_* in
+  // protocols/chordv.h).
+  static const uint NTYPES = 9;
+
+private:
+  static bool _on;
+  static Time _window;
+  static Time _start;
+  static Time _next;
+  static ofstream _out;
+
+  static Histogram _lookups;
+  static Histogram _hops;
+  static uint64_t _failed;
+  static uint64_t _incorrect;
+  static uint64_t _timeouts;
+  static Histogram _queries;
+  static uint64_t _queries_failed;
+  static unsigned long long _bytes[NTYPES + 1];
+
+  static void schedule();
+  static void reset();
+};
+
+#endif // __TIMELINE_H
@@ -27,6 +27,7 @@
 
 // abstract super class of a topology
 #include <fstream>
+#include <map>
 #include "../p2psim/parse.h"
 #include "p2psim.h"
 using namespace std;
@@ -46,12 +47,21 @@ public:
   unsigned noise_variance() { return _noise; }
   unsigned num() { return _num; }
 
+  // access link bandwidth of a node in kbit/s, 0 for no limit.  the link
+  // model is on if any node has a limit, see Network::link_out()
+  bool link_model() { return _bw_up || _bw_down || !_node_bw.empty(); }
+  unsigned bw_up(IPAddress);
+  unsigned bw_down(IPAddress);
+
 protected:
   Topology();
   Time _med_lat;
   unsigned _lossrate;
   unsigned _noise;
   unsigned int _num;
+  unsigned _bw_up;
+  unsigned _bw_down;
+  map<IPAddress, pair<unsigned, unsigned> > _node_bw; // by first ip
 };
 
 #endif //  __TOPOLOGY_H
@@ -29,6 +29,7 @@
 #include "../p2psim/p2protocol.h"
 #include "consistenthash.h"
 #include "../p2psim/network.h"
+#include "../p2psim/log.h"
 #include "../protocols/chord.h"
 #include <map>
 
@@ -461,13 +462,14 @@ public:
       cout<< "Consistent Hashing ID: "<< me.id <<endl;
       // cout<< "Alive Time: "<< me.alivetime <<endl;
       // cout<< "_prev_succ: "<< _prev_succ <<endl;
-      cout << "Data: "<< endl;
-      key_pair* current = key_pairs.first();
-      std::cout << "key_pairs0***********************************" << std::endl;
-      while (current) {
-          std::cout << "Hash ID: " << current->hash_id << ", Original Key: " << current->original_key << std::endl;
-          current = key_pairs.next(current);
+      // the keys themselves go to the binary log (-L data=2:FILE)
+      unsigned nkeys = 0;
+      for (key_pair* current = key_pairs.first(); current; current = key_pairs.next(current)) {
+          LOG(LOG_DATA, LOG_DEBUG, "node %u key hash %llu original %llu",
+              me.ip, current->hash_id, current->original_key);
+          nkeys++;
       }
+      cout << "Data: " << nkeys << " keys" << endl;
       cout << "Real Node IP:"<<endl;
       cout<<real_node_ip<<endl;
       cout << "Virtual Node Pairs (IP): "<< endl;
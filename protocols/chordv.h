@@ -29,8 +29,11 @@
 #include "../p2psim/p2protocol.h"
 #include "consistenthash.h"
 #include "../p2psim/network.h"
+#include "../p2psim/log.h"
 #include "../protocols/chord.h"
 #include <map>
+#include <deque>
+#include <algorithm>
 
 
 
@@ -51,9 +54,18 @@
 #define TYPE_FINGER_UP 6
 #define TYPE_PNS_UP 7
 #define TYPE_MISC 8
+#define TYPE_BALANCE 9
+#define TYPE_DATA 10
 
 #define MIN_BASIC_TIMER 100
 
+#define VIVALDI_CC 0.25 //coordinate step
+#define VIVALDI_CE 0.25 //error smoothing
+#define VIVALDI_MIN_HT 1.0
+#define COORD_BYTES 24 //3 floats, the error and the 8 byte timestamp
+
+#define SEEN_TIMEOUT 60000 //how long a node remembers the parallel lookups it forwarded
+
 class LocTable_vnodes;
 
 class Chord_vnodes : public P2Protocol {
@@ -74,6 +86,33 @@ public:
         bool operator==(const IDMap a) { return (a.id == id); }
     };
 
+    // the live ring sorted by id, as the oracle sees it.  positions wrap.
+    class Ring {
+    public:
+        virtual ~Ring() {}
+        virtual uint size() = 0;
+        virtual IDMap at(long pos) = 0;
+        // position of the first node whose id is >= k, or size() if none is
+        virtual long lower(CHID k) = 0;
+    };
+    // a Ring over a sorted vector; read-only, so threads may share one
+    class SortedRing : public Ring {
+    public:
+        SortedRing(const vector<IDMap> &v) : _v(v) {}
+        uint size() { return _v.size(); }
+        IDMap at(long pos) {
+            long sz = _v.size();
+            pos %= sz;
+            return _v[pos < 0 ? pos + sz : pos];
+        }
+        long lower(CHID k) {
+            return std::lower_bound(_v.begin(), _v.end(), k,
+                    [](const IDMap &a, CHID k) { return a.id < k; }) - _v.begin();
+        }
+    private:
+        const vector<IDMap> &_v;
+    };
+
   Chord_vnodes(IPAddress i,  Args& a, LocTable_vnodes *l = NULL, const char *name=NULL);
   virtual ~Chord_vnodes();
   virtual string proto_name() { return "Chord"; }
@@ -84,6 +123,7 @@ public:
   virtual void crash(Args*);
   virtual void lookup(Args*);
   virtual void query(Args*);
+  virtual void execute_op(event_f, const p2p_op &);
   //virtual void insert(Args*);
   virtual void display(Args*);
   virtual void range_query_leanred(Args*);
@@ -93,14 +133,28 @@ public:
   virtual void print_query_stats();
   virtual void print_query_stats_batch();
 
+  // Vivaldi synthetic coordinates (Dabek et al., SIGCOMM 2004): two
+  // dimensions plus a height for the access link, all in ms of rtt
+  struct Coord {
+    double x[2];
+    double ht;
+    double err; //relative error, < 0 if never sampled
+    Time at; //when its owner sent it, newer ones replace older ones
+    Coord() : ht(VIVALDI_MIN_HT), err(-1), at(0) { x[0] = x[1] = 0; }
+    double dist(const Coord &c) const;
+  };
+
   struct get_predsucc_args {
     bool pred; //need to get predecessor?
     int m; //number of successors wanted 0
+    IDMap notify; //batchstab: the sender, to be notified as if by notify_handler
+    get_predsucc_args() : pred(false), m(0) { notify.ip = 0; }
   };
   struct get_predsucc_ret {
     vector<IDMap> v;
     IDMap dst;
     IDMap n;
+    vector<Coord> c; //pns only: coordinates of dst, n and v as dst knows them
   };
   struct notify_args {
     IDMap me;
@@ -154,13 +208,19 @@ public:
   struct lookup_path {
     IDMap n;
     bool tout;
+  };
+  struct move_args {
+    CHID host; //the pair_group to move to
+    IPAddress slot; //first ip of a dead vnode of host that takes over
   };
     struct key_pair {
         // hash_id, original_key
         CHID hash_id;
         CHID original_key;
+        size_t value_off; //the value: value_len bytes at value_off in the arena
+        size_t value_len;
         sklist_entry<key_pair> sortlink_;
-        key_pair(CHID h, CHID o) : hash_id(h), original_key(o) {}
+        key_pair(CHID h, CHID o) : hash_id(h), original_key(o), value_off(0), value_len(0) {}
     };
 
     struct idmapcompare{
@@ -180,6 +240,8 @@ public:
     IPAddress ipkey;
     uint m;
     IDMap src;
+    uint alpha; //next hops each node forwards to
+    uint nonce; //with src, names the lookup when alpha > 1
   };
   struct next_recurs_ret {
     vector<IDMap> v;
@@ -189,9 +251,46 @@ public:
     IDMap lasthop;
     IDMap prevhop;
     IDMap nexthop;
+    bool dup; //this branch of a parallel lookup ran into another one
     skiplist<key_pair, CHID, &key_pair::hash_id, &key_pair::sortlink_, idmapcompare> *data_address;
     IPAddress successor;
   };
+  struct recurs_gc_args {
+    RPCSet rpcset;
+    hash_map<unsigned, next_recurs_ret *> resultmap;
+    next_recurs_args *args;
+    uint type;
+  };
+  struct cache_entry {
+    IDMap pred; //the owner holds (pred, owner]
+    IDMap owner;
+    list<CHID>::iterator lru;
+  };
+  struct store_args {
+    CHID hash_id;
+    CHID or_key;
+    const char *value; //the sender's copy, the owner copies it
+    size_t value_len;
+  };
+  struct store_ret {
+    bool stored;
+  };
+  struct fetch_args {
+    CHID hash_id;
+  };
+  struct fetch_ret {
+    bool found;
+    string value;
+  };
+  struct scan_args {
+    CHID lo; //keys in (lo, hi]
+    CHID hi;
+  };
+  struct scan_ret {
+    vector<CHID> keys;
+    string values; //back to back, in key order
+    IDMap succ;
+  };
   struct lookup_args{
     CHID key;
     IPAddress ipkey;
@@ -206,6 +305,7 @@ public:
     CHID hash_id;
     CHID query_range;
     skiplist<key_pair, CHID, &key_pair::hash_id, &key_pair::sortlink_, idmapcompare> *data_address;
+    IPAddress src; //migrate_data: the vnode data_address belongs to
   };
 
 
@@ -220,21 +320,39 @@ public:
   void find_successors_handler_query(find_successors_args *, find_successors_ret *);
   void final_recurs_hop(next_recurs_args *args, next_recurs_ret *ret);
   void next_recurs_handler(next_recurs_args *, next_recurs_ret *);
+  void store_handler(store_args *, store_ret *);
+  void fetch_handler(fetch_args *, fetch_ret *);
+  void scan_handler(scan_args *, scan_ret *);
   void lookup_internal(lookup_args *a);
   void query_internal(lookup_args *a);
+  void insert_internal(lookup_args *a);
+  void range_query_internal(lookup_args *a);
+  lookup_args *start_lookup(CHID key);
+  //latency of the range queries that completed; the query stats mix
+  //them with lookups
+  static Histogram _range_lat;
+  //latency of the inserts that completed, kept out of the lookup stats
+  static Histogram _insert_lat;
+  static uint _insert_failed;
+
+  // the data path, given the owner of hash_id: put() stores a value
+  // there, get() fetches it.  both block and charge the value bytes.
+  bool put(IDMap owner, CHID hash_id, CHID or_key, const char *value, size_t len);
+  bool get(IDMap owner, CHID hash_id, string *value);
   void display_node(){
       cout<< "..............................................."<<endl;
       cout<< "............Current Node ip: "<< me.ip << "............."<<endl;
       cout<< "Consistent Hashing ID: "<< me.id <<endl;
       // cout<< "Alive Time: "<< me.alivetime <<endl;
       // cout<< "_prev_succ: "<< _prev_succ <<endl;
-      cout << "Data: "<< endl;
-      key_pair* current = key_pairs.first();
-      std::cout << "key_pairs0***********************************" << std::endl;
-      while (current) {
-          std::cout << "Hash ID: " << current->hash_id << ", Original Key: " << current->original_key << std::endl;
-          current = key_pairs.next(current);
+      // the keys themselves go to the binary log (-L data=2:FILE)
+      unsigned nkeys = 0;
+      for (key_pair* current = key_pairs.first(); current; current = key_pairs.next(current)) {
+          LOG(LOG_DATA, LOG_DEBUG, "node %u key hash %llu original %llu",
+              me.ip, current->hash_id, current->original_key);
+          nkeys++;
       }
+      cout << "Data: " << nkeys << " keys" << endl;
       cout << "Real Node IP:"<<endl;
       cout<<real_node_ip<<endl;
       cout << "Virtual Node Pairs (IP): "<< endl;
@@ -245,37 +363,20 @@ public:
 // real node ip, virtual node id, num_of_key_value_pairs
 // cout<< real_node_ip << ","<<me.ip<<","<<data_.size()<<endl;
   }
-  void migrate_data(lookup_args *args, next_recurs_ret *ret) {
-        skiplist<key_pair, CHID, &key_pair::hash_id, &key_pair::sortlink_, idmapcompare> *new_node_data_address = args->data_address;
-        CHID new_node_id = args->key;
-        ret->data_address = &key_pairs; // return data_ to new node
-        // migrate key pairs
-        vector<CHID> key_vector;
-        key_pair* current = key_pairs.first();
-        while (current) {
-            CHID current_id = current->hash_id;
-            CHID current_key = current->original_key;
-            if (ConsistentHash::distance(current_id, new_node_id) < ConsistentHash::distance(current_id, me.id)) {
-                key_pair* k = new key_pair(current_id, current_key);
-                new_node_data_address->insert(k);
-                key_vector.push_back(current_id);
-            } else{
-                break;
-            }
-            current = key_pairs.next(current);
-        }
-      if (!key_vector.empty()){
-          for (CHID i: key_vector) {
-              key_pairs.remove(i);
-          }
-      }
-  }
+  void migrate_data(lookup_args *args, next_recurs_ret *ret);
 
   void alert_delete(alert_args *aa);
 
   CHID id() { return me.id; }
   IDMap idmap() { return me;}
   virtual void initstate();
+  void initstate(Ring &ids);
+  virtual bool initstate_all(const set<Node*> *);
+  virtual void save_state(ofstream&);
+  virtual void load_state(ifstream&);
+  virtual void save_shared(ofstream&);
+  virtual void load_shared(ifstream&);
+  virtual void restored();
   virtual bool stabilized(vector<CHID>);
   bool check_correctness(CHID k, vector<IDMap> v);
   virtual void oracle_node_died(IDMap n);
@@ -295,10 +396,15 @@ public:
   virtual void reschedule_basic_stabilizer(void *);
 
   bool inited() {return _inited;};
+  uint nsucc() {return _nsucc;};
   char *print_path(vector<lookup_path> &p, char *tmp);
 
 
 protected:
+  // what initstate() puts in the location table: the successors and the
+  // predecessor, plus fingers in subclasses.  duplicates are fine.
+  virtual void static_entries(Ring &ids, long my_pos, vector<IDMap> &v);
+
   //chord parameters
   uint _nsucc;
   uint _allfrag;
@@ -322,6 +428,7 @@ protected:
   uint _ipkey;
   uint _last_succlist_stabilized;
   uint _random_id;
+  uint _siblings;
 
   LocTable_vnodes *loctable;
   LocTable_vnodes *learntable;
@@ -354,9 +461,99 @@ protected:
   void fix_predecessor();
   void fix_successor_list();
   void check_static_init();
-  void record_stat(IPAddress src, IPAddress dst, uint type, uint num_ids, uint num_else = 0);
+  Chord_vnodes *closer_sibling(CHID key, IDMap next);
+  bool next_recurs_parallel(next_recurs_args *args, next_recurs_ret *ret, IDMap next);
+  bool seen_lookup(next_recurs_args *args);
+  void recurs_gc(recurs_gc_args *g);
+  void recurs_free(next_recurs_args *args, RPCSet &rpcset,
+                   hash_map<unsigned, next_recurs_ret *> &resultmap, uint type);
+  void record_stat(IPAddress src, IPAddress dst, uint type, uint num_ids, uint64_t num_else = 0);
   void record_lookupstat(uint num, uint type);
 
+  //proximity neighbour selection: Vivaldi coordinates of me and of the
+  //nodes i have heard of, learned from get_predsucc replies
+  uint _pns;
+  Coord _coord;
+  hash_map<IPAddress, Coord> _coords;
+  Time _last_rtt; //of the last successful failure_detect()
+  void vivaldi_sample(IPAddress who, const Coord &c, Time rtt);
+  void learn_coords(get_predsucc_ret &gpr);
+  double predicted_rtt(IPAddress ip);
+
+  //lookup cache: owners of ring intervals learned from lookups i made or
+  //forwarded, keyed by owner id, least recently used at the back
+  uint _cache_size;
+  map<CHID, cache_entry> _cache;
+  list<CHID> _cache_lru;
+  static uint _cache_tries, _cache_hits, _cache_stale;
+  bool cache_lookup(CHID key, uint m, IDMap *lasthop, lookup_args *a, vector<IDMap> &results);
+  void cache_learn(IDMap pred, IDMap owner);
+  void cache_forget(IDMap n);
+
+  //parallel recursive lookups: the ones i started and the ones i forwarded
+  uint _nonce;
+  hash_map<unsigned long long, Time> _seen;
+  deque<unsigned long long> _seen_order;
+
+  //batched stabilization: fix_successor checks my successor's
+  //predecessor, notifies it and fetches its successor list in one RPC,
+  //whose reply fix_successor_list then uses
+  uint _batch_stab;
+  get_predsucc_ret _stab_succs;
+  Time _stab_succs_at;
+  void stash_succs(get_predsucc_ret &gpr);
+
+  //adaptive stabilization: the timers shrink while the neighbourhood
+  //changes and grow while it does not, and the maintenance traffic of
+  //a vnode is held under _stab_budget bytes/s
+  uint _adaptive;
+  uint _stab_basic_min;
+  uint _stab_basic_max;
+  uint _stab_budget;
+  uint _stab_timeouts; //failed failure_detect()s since the last basic round
+  vector<CHID> _stab_neighbours; //pred and succs after the last basic round
+  double _stab_quota;
+  Time _stab_quota_time;
+  unsigned long long _maint_bytes, _maint_bytes_seen;
+  static double _basic_period_sum, _finger_period_sum;
+  static uint _basic_rounds, _finger_rounds, _lookup_retries;
+  uint neighbour_changes();
+  uint adapt_timer(uint timer, uint lo, uint hi, uint changes);
+  uint stab_budget_wait();
+  void print_maintenance_stats();
+
+  //load balancing: with balance=PERIOD the well-known node moves vnodes
+  //from the host holding the most keys to the one holding the fewest.
+  //a move needs a dead vnode on the new host (see spares= in
+  //VnodeEventGenerator)
+  uint _balance;
+  double _balance_thresh;
+  uint _balance_moves;
+  IPAddress _moving_to; //the vnode that takes over from me while I move
+  static uint _moves_done;
+  static unsigned long long _moved_bytes;
+  void balance(void *);
+  void move_vnode(move_args *m);
+  void free_slots(CHID host, vector<IPAddress> &v);
+
+  //values: with valuesize=BYTES an insert carries a value of that mean
+  //size, drawn from valuedist, and a lookup fetches it from the owner.
+  //a vnode keeps the values of its keys back to back in _arena; dropped
+  //values leave holes until compact_arena()
+  enum { VALUE_FIXED, VALUE_UNIFORM, VALUE_EXP, VALUE_PARETO };
+  uint _value_size;
+  uint _value_dist;
+  uint _value_max;
+  vector<char> _arena;
+  size_t _arena_dead;
+  uint draw_value_size();
+  void make_value(CHID key, uint len, string &v);
+  void set_value(key_pair *k, const char *v, size_t len);
+  void drop_value(key_pair *k);
+  const char *value(key_pair *k) { return k->value_len ? &_arena[k->value_off] : ""; }
+  size_t value_bytes() { return _arena.size() - _arena_dead; }
+  void compact_arena();
+
 private:
   Time _last_join_time;
   static vector<uint> rtable_sz;
@@ -413,16 +610,19 @@ class LocTable_vnodes{
     Chord_vnodes::IDMap pred(Chord_vnodes::CHID id, int status = LOC_ONCHECK);
     void checkpoint();
     void print();
+    void save(ofstream &out);
+    void load(ifstream &in);
 
     bool update_ifexists(Chord_vnodes::IDMap n, bool replacement=false);
     bool add_node(Chord_vnodes::IDMap n, bool is_succ=false, bool assertadd=false,Chord_vnodes::CHID fs=0,Chord_vnodes::CHID fe=0, bool replacement=false);
     int add_check(Chord_vnodes::IDMap n);
-    void add_sortednodes(vector<Chord_vnodes::IDMap> l);
+    void add_sortednodes(vector<Chord_vnodes::IDMap> l, uint nsucc);
     bool del_node(Chord_vnodes::IDMap n, bool force=false);
     virtual void del_all();
     void notify(Chord_vnodes::IDMap n);
     uint size(uint status=LOC_HEALTHY, double to = 0.0);
     uint succ_size();
+    void trim_succs(uint m);
     void last_succ(Chord_vnodes::IDMap n);
     uint live_size(double to = 0.0);
     bool is_succ(Chord_vnodes::IDMap n);
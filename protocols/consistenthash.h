@@ -32,6 +32,7 @@
 #include <assert.h>
 #include <cstring>
 #include "../p2psim/parse.h"
+#include "../p2psim/rng.h"
 
 
 class ConsistentHash {
@@ -82,10 +83,11 @@ public:
     return (n + (one << p));
   }
 
+  // nodes pass their own rng(RNG_ID); the rest share one stream
+  static CHID getRandID(Rng &r) { return r.next(); }
   static CHID getRandID() {
-    CHID r = random();
-    r = (r << 32) | random ();
-    return r;
+    static Rng r(0, RNG_KEY);
+    return r.next();
   }
 
   static CHID ip2chid(IPAddress ip) {
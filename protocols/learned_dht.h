@@ -44,16 +44,26 @@ public:
 
     void dump();
 
-    void initstate();
+    void save_state(ofstream &);
+    void load_state(ifstream &);
+    void restored();
 
     virtual void join(Args *);
 
 protected:
     uint _fingerlets;
     uint _stab_finger_timer;
+    uint _stab_finger_min; //bounds of _stab_finger_timer with adaptivestab
+    uint _stab_finger_max;
+    uint _finger_changes; //dead and newly looked up fingers in the last round
 
     void fix_fingers(bool restart = false);
 
+    void static_entries(Ring &ids, long my_pos, vector<IDMap> &v);
+
+    void pns_finger(CHID finger, CHID lap, IDMap currf, Time currf_rtt, get_predsucc_ret &gpr);
+    uint _samples; //pns: successors of a finger to consider in its place
+
     uint _base;
     //uint _maxf;
     //uint _numf; //number of fingers ChordFinger should be keeping
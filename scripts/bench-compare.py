@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+"""bench-compare.py
+
+Compares two sim-scale-bench.py results files run by run (protocol name
+and node count) and flags regressions: wall time, per-phase time or peak
+RSS up, or events/s down, by more than the threshold.  A run that was ok
+in OLD and is not in NEW is a regression too.  When a file holds several
+lines for the same run, the last one counts.
+
+Usage:
+
+    bench-compare.py [--threshold PERCENT] OLD NEW
+
+Exits 1 if there is a regression.
+"""
+
+import argparse, sys
+
+# metric -> True if bigger is better
+metrics = [("wall_s", False), ("events_per_s", True), ("maxrss_kb", False),
+           ("topology_s", False), ("join_s", False), ("steady_s", False),
+           ("stats_s", False)]
+
+
+def load(path):
+    runs = {}
+    for line in open(path):
+        kv = dict(w.split("=", 1) for w in line.split() if "=" in w)
+        if "name" in kv and "nodes" in kv:
+            runs[(kv["name"], int(kv["nodes"]))] = kv
+    return runs
+
+
+def main():
+    p = argparse.ArgumentParser(description="compare two benchmark results")
+    p.add_argument("--threshold", type=float, default=10,
+                   help="percent change that counts as a regression")
+    p.add_argument("--min-seconds", type=float, default=0.05,
+                   help="ignore time metrics below this in both files")
+    p.add_argument("old")
+    p.add_argument("new")
+    a = p.parse_args()
+
+    old = load(a.old)
+    new = load(a.new)
+    regressions = 0
+
+    print("%-12s %6s  %-13s %12s %12s %8s" %
+          ("name", "nodes", "metric", "old", "new", "change"))
+    for key in sorted(set(old) | set(new)):
+        o, n = old.get(key), new.get(key)
+        if not o or not n:
+            print("%-12s %6d  only in %s" % (key[0], key[1],
+                                              a.old if o else a.new))
+            continue
+        if o["status"] != "ok" or n["status"] != "ok":
+            bad = o["status"] == "ok"
+            regressions += bad
+            print("%-12s %6d  %-13s %12s %12s %8s" %
+                  (key[0], key[1], "status", o["status"], n["status"],
+                   "REGRESSED" if bad else ""))
+            continue
+        for m, up in metrics:
+            if m not in o or m not in n:
+                continue
+            ov, nv = float(o[m]), float(n[m])
+            if m.endswith("_s") and max(ov, nv) < a.min_seconds:
+                continue
+            change = 100.0 * (nv - ov) / ov if ov else 0.0
+            bad = (-change if up else change) > a.threshold
+            regressions += bad
+            print("%-12s %6d  %-13s %12.4g %12.4g %+7.1f%%%s" %
+                  (key[0], key[1], m, ov, nv, change,
+                   " REGRESSED" if bad else ""))
+
+    if regressions:
+        print("%d regression(s) over %g%%" % (regressions, a.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
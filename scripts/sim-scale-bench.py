@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+"""sim-scale-bench.py
+
+Measures how the simulator itself scales: runs each protocol in
+example/scale at each network size and appends one line per run to a
+results file, as written by p2psim -B:
+
+    name=LearnedDHT nodes=256 status=ok wall_s=... events_per_s=...
+        maxrss_kb=... coroutines=... topology_s=... join_s=... steady_s=...
+        stats_s=...
+
+A run that crashes or times out gets a line with status=crash or
+status=timeout instead.  Compare two results files with bench-compare.py.
+
+Usage:
+
+    sim-scale-bench.py --sim PATH [--out FILE] [--protocols a,b]
+                       [--sizes 256,1024] [--seed N] [--timeout SECS]
+
+Also the sim_scale_bench make target.
+"""
+
+import argparse, os, subprocess, sys, time
+
+here = os.path.dirname(os.path.abspath(__file__))
+configs = os.path.join(here, "..", "example", "scale")
+
+# config file suffix -> name in the results
+protocols = [("learneddht", "LearnedDHT"), ("chord", "Chord"),
+             ("kademlia", "Kademlia"), ("marques", "Marques")]
+sizes = [256, 1024, 4096, 16384]
+
+
+def main():
+    p = argparse.ArgumentParser(description="simulator scalability benchmark")
+    p.add_argument("--sim", required=True, help="the learned_dht binary")
+    p.add_argument("--out", default="sim_scale_bench.txt",
+                   help="results file, appended to")
+    p.add_argument("--protocols", default=",".join(f for f, _ in protocols))
+    p.add_argument("--sizes", default=",".join(str(n) for n in sizes))
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--timeout", type=float, default=600,
+                   help="seconds before a run counts as timed out")
+    a = p.parse_args()
+
+    sim = os.path.abspath(a.sim)
+    out = os.path.abspath(a.out)
+    names = dict(protocols)
+
+    work = os.path.join(os.path.dirname(out), "sim_scale_bench.d")
+    os.makedirs(os.path.join(work, "run"), exist_ok=True)
+
+    for f in a.protocols.split(","):
+        if f not in names:
+            sys.exit("unknown protocol %s, have %s" %
+                     (f, ", ".join(names)))
+        for n in [int(x) for x in a.sizes.split(",")]:
+            cmd = [sim, "-e", str(a.seed), "-B", "%s:%s" % (out, names[f]),
+                   os.path.join(configs, "protocol-%s.txt" % f),
+                   os.path.join(configs, "topology-%d.txt" % n),
+                   os.path.join(configs, "events-%s.txt" % f)]
+            sys.stderr.write("%s %d nodes... " % (names[f], n))
+            sys.stderr.flush()
+            t0 = time.time()
+            try:
+                r = subprocess.run(cmd, cwd=os.path.join(work, "run"),
+                                   stdout=subprocess.DEVNULL,
+                                   stderr=subprocess.PIPE,
+                                   timeout=a.timeout)
+                status = "ok" if r.returncode == 0 else "crash"
+            except subprocess.TimeoutExpired:
+                status = "timeout"
+            wall = time.time() - t0
+            sys.stderr.write("%s, %.1f s\n" % (status, wall))
+            if status != "ok":
+                with open(out, "a") as o:
+                    o.write("name=%s nodes=%d status=%s wall_s=%g\n" %
+                            (names[f], n, status, wall))
+
+
+if __name__ == "__main__":
+    main()
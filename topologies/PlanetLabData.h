@@ -27,6 +27,7 @@
 
 #include "../p2psim/p2psim.h"
 #include "../p2psim/topology.h"
+#include "latencymatrix.h"
 
 class PlanetLabData : public Topology {
 public:
@@ -40,6 +41,7 @@ public:
 
 private:
   hash_map<IPAddress, Coord> _nodes;
+  LatencyMatrix _lat;
 };
 
 #endif //  __PLANETLABDATA_H
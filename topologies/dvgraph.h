@@ -31,12 +31,20 @@
 // other (and the link latencies), and DVGraph will compute
 // the paths between all nodes and the path latencies.
 // So DVGraph implements latency() for you.
+//
+// Paths are computed per source with Dijkstra, on demand, and the
+// resulting rows of path latencies are kept in an LRU cache.  Memory is
+// O(links + cache rows * n) instead of the O(n^2) link matrix and route
+// table the old all-pairs distance-vector computation needed.  The cache
+// size can be given as cache=ROWS on the topology line; by default it is
+// bounded to 64MB of rows.
 
 #include "../p2psim/topology.h"
+#include <list>
 
 class DVGraph : public Topology {
 public:
-  DVGraph();
+  DVGraph(vector<string>* = 0);
   ~DVGraph();
   
   Time latency(IPAddress a, IPAddress b, bool reply = false);
@@ -46,24 +54,30 @@ public:
   int _n; // # of nodes
   vector<IPAddress> _i2ip;
   hash_map<IPAddress, int> _ip2i;
-  short *_links;   // 2-d matrix of link delays, -1 for none.
 
   void add_node(IPAddress a);
-  short& links(int i, int j) { return _links[i*_n + j]; }
+  // (re)sets the delay of the bidirectional link between i and j
+  void add_link(int i, int j, int m);
   
  private:
-  int _initialized;
-
-  // per-node forwarding tables
-  struct Entry {
-    int _next;
+  struct Link {
+    int _to;
     int _metric;
-    int _hops;
   };
-  Entry *_routes;
-  Entry& routes(int i, int j) { return _routes[i*_n + j]; }
+  vector< vector<Link> > _adj;
+
+  int _initialized;
+  unsigned _cache_rows;
+
+  // LRU cache of source rows, most recently used first
+  typedef unsigned short metric_t;
+  vector<metric_t *> _rows;       // per source, 0 if not cached
+  list<int> _lru;
+  vector<list<int>::iterator> _lru_pos;
 
-  void dv();
+  void init();
+  metric_t *row(int src);
+  void dijkstra(int src, metric_t *dist, vector<int> *hops = 0);
 };
 
 #endif //  __DVGRAPH_H
@@ -0,0 +1,63 @@
+#ifndef __LATENCYMATRIX_H
+#define __LATENCYMATRIX_H
+
+// Square all-pairs latency matrix (in ms), used by PlanetLabData.
+//
+// The binary format is a 32 byte header followed by the n*n row-major
+// entries, either as 32-bit floats or as 16-bit unsigned integers
+// (whole ms, which is all latency() uses anyway):
+//
+//   char     magic[8]    "P2PLATM1"
+//   uint32_t n
+//   uint32_t type        LATM_FLOAT or LATM_UINT16
+//   uint64_t reserved[2]
+//
+// Binary files are mmap'd read-only, so loading costs no parsing and the
+// pages are shared by all simulator processes using the same file.  Plain
+// whitespace separated text matrices are still accepted, but are parsed
+// into a private buffer; use latconvert to turn them into binary files.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+class LatencyMatrix {
+public:
+  enum { LATM_FLOAT = 0, LATM_UINT16 = 1 };
+
+  LatencyMatrix();
+  ~LatencyMatrix();
+
+  // returns false (and prints why) if the file cannot be loaded
+  bool open(string file);
+  // writes the matrix in binary format with the given entry type
+  bool write(string file, unsigned type);
+
+  unsigned size() { return _n; }
+  float at(unsigned i, unsigned j) {
+    size_t k = (size_t) i * _n + j;
+    return _f ? _f[k] : (float) _u[k];
+  }
+
+private:
+  struct header {
+    char magic[8];
+    uint32_t n;
+    uint32_t type;
+    uint64_t reserved[2];
+  };
+
+  bool open_text(string file);
+
+  unsigned _n;
+  const float *_f;
+  const uint16_t *_u;
+
+  void *_map;      // mmap'd file, if binary
+  size_t _maplen;
+  vector<float> _buf; // parsed matrix, if text
+};
+
+#endif // __LATENCYMATRIX_H